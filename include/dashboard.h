@@ -6,18 +6,29 @@
 #include <vector>
 #include "heatmap.h"
 #include "metrics.h"
+#include "temporal.h"
 
 namespace VideoQuality {
 
 class Dashboard {
 public:
     Dashboard(const std::string& originalPath, 
-              const std::string& compressedPath);
+              const std::string& compressedPath,
+              int bitDepthHint = 0);
     ~Dashboard();
     
     // Run the interactive dashboard
     void run();
     
+    // Tile size for per-tile PSNR/SSIM grids (0 disables tile maps)
+    void setTileSize(int tileSize);
+    
+    // Tile SSIM drawn at full heat in the tile map
+    void setSSIMFloor(double ssimFloor);
+    
+    // Scaler for compressed frames of a different size (cv::INTER_*, see parseScaler)
+    void setInterpolation(int interpolation);
+    
     // Window names
     static const std::string WIN_ORIGINAL;
     static const std::string WIN_COMPRESSED;
@@ -32,6 +43,7 @@ private:
     // Current state
     int currentFrame_;
     int totalFrames_;
+    int bitDepthHint_;
     double fps_;
     bool playing_;
     
@@ -42,8 +54,13 @@ private:
     struct FrameMetrics {
         double psnr;
         double ssim;
+        TileMetrics tiles;
+        double flicker;
+        TemporalAnalyzer::FrameEvent event;
     };
     std::vector<FrameMetrics> metricsCache_;
+    TemporalAnalyzer temporal_;
+    int lastTemporalFrame_;   // last frame fed to temporal_, which needs consecutive frames
     
     // UI methods
     void setupWindows();
@@ -73,6 +90,9 @@ private:
     int displayHeight_;
     double heatmapAlpha_;
     int colormapType_;
+    int tileSize_;
+    bool showTileMap_;
+    int interpolation_;
 };
 
 } // namespace VideoQuality
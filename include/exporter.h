@@ -0,0 +1,66 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include "heatmap.h"
+#include "metrics.h"
+
+namespace VideoQuality {
+
+// Headless side-by-side review video: original | compressed | heatmap
+// overlay above a metrics banner. Decode, render and encode run on
+// separate threads; no HighGUI calls are made.
+class ComparisonExporter {
+public:
+    struct Options {
+        int panelWidth;        // width of each of the three panels
+        double heatmapAlpha;
+        int colormapType;
+        int tileSize;          // SSIM tile map as heatmap source (0 = pixel difference)
+        double ssimFloor;      // tile SSIM drawn at full heat
+        int interpolation;     // scaler for mismatched sizes (cv::INTER_*)
+        int bitDepthHint;      // significant bits of 16-bit frames
+        int renderThreads;     // 0 = hardware concurrency
+        std::string fourcc;    // ignored for .y4m output
+
+        Options();
+    };
+
+    ComparisonExporter(const std::string& originalPath,
+                       const std::string& compressedPath,
+                       const Options& options = Options());
+
+    // Render every frame into outputPath (.y4m is written raw, anything
+    // else goes through cv::VideoWriter). Returns the number of frames written.
+    int run(const std::string& outputPath);
+
+    static const int BANNER_HEIGHT = 40;
+
+private:
+    struct FramePair {
+        int index;
+        cv::Mat original;
+        cv::Mat compressed;
+    };
+
+    struct RenderedFrame {
+        int index;
+        cv::Mat image;
+    };
+
+    cv::VideoCapture originalVideo_;
+    cv::VideoCapture compressedVideo_;
+    Options options_;
+    int totalFrames_;
+    double fps_;
+    cv::Size panelSize_;
+    cv::Size outputSize_;
+
+    cv::Mat renderFrame(const FramePair& pair, HeatmapGenerator& heatmapGen);
+    cv::Mat toDisplay(const cv::Mat& frame) const;
+};
+
+} // namespace VideoQuality
+
+#endif // EXPORTER_H
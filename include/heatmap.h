@@ -5,6 +5,8 @@
 
 namespace VideoQuality {
 
+// Not thread-safe: generators keep a scratch buffer (resized_) between calls,
+// so use one instance per thread.
 class HeatmapGenerator {
 public:
     HeatmapGenerator();
@@ -20,6 +22,14 @@ public:
                            double alpha = 0.5,
                            int colormapType = cv::COLORMAP_JET);
     
+    // Generate overlay from a per-tile SSIM grid (see TileMetrics) without
+    // touching the pixel difference. Colours use a fixed scale from SSIM 1.0
+    // (coldest) down to the SSIM floor (hottest), so frames stay comparable.
+    cv::Mat generateTileOverlay(const cv::Mat& original,
+                               const cv::Mat& ssimTiles,
+                               double alpha = 0.5,
+                               int colormapType = cv::COLORMAP_JET);
+    
     // Calculate difference statistics
     struct DifferenceStats {
         double minError;
@@ -31,13 +41,41 @@ public:
     DifferenceStats calculateStats(const cv::Mat& original,
                                    const cv::Mat& compressed);
     
-    // Set sensitivity threshold (0-255)
+    // Set sensitivity threshold (0-255, scaled to the frame's bit depth)
     void setThreshold(double threshold);
     
+    // Tile SSIM shown at full heat in tile overlays (below 1.0, default 0.7)
+    void setSSIMFloor(double ssimFloor);
+    
+    // Significant bits of 16-bit frames (10, 12 or 16)
+    void setBitDepth(int bitDepth);
+    
+    // Interpolation used when the compressed frame is a different size
+    // (cv::INTER_*, see parseScaler)
+    void setInterpolation(int interpolation);
+    
 private:
     double threshold_;
+    double ssimFloor_;
+    int bitDepth_;
+    int interpolation_;
+    cv::Mat resized_;   // reused across frames to avoid reallocating
+    
+    // Kernels specialized per sample format (see SampleTraits)
+    template <typename Traits>
+    cv::Mat generateHeatmapImpl(const cv::Mat& original,
+                                const cv::Mat& compressed,
+                                int colormapType);
+    template <typename Traits>
+    cv::Mat generateOverlayImpl(const cv::Mat& original,
+                                const cv::Mat& compressed,
+                                double alpha,
+                                int colormapType);
+    
     cv::Mat calculateDifference(const cv::Mat& img1, const cv::Mat& img2);
     cv::Mat normalizeForDisplay(const cv::Mat& diff);
+    cv::Mat blendOverlay(const cv::Mat& original, cv::Mat heatmap,
+                         double alpha, double peak);
 };
 
 } // namespace VideoQuality
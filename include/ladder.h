@@ -0,0 +1,58 @@
+#ifndef LADDER_H
+#define LADDER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace VideoQuality {
+
+// How renditions of an encoding ladder are brought to a common size
+enum LadderScaleMode {
+    LADDER_UPSCALE_RENDITION,    // scale each rendition up to the reference size
+    LADDER_DOWNSCALE_REFERENCE   // score against the reference scaled to the rendition size
+};
+
+// Map a scaler name (nearest, bilinear, bicubic, area, lanczos) onto the
+// matching cv::resize interpolation flag. Returns -1 for unknown names.
+int parseScaler(const std::string& name);
+
+// Aligns every rendition of a ladder with one reference frame. Downscaled
+// reference levels are computed once per frame and shared by all renditions
+// of that size; every buffer is kept across frames so steady-state scaling
+// does not allocate.
+class LadderScaler {
+public:
+    LadderScaler(LadderScaleMode mode = LADDER_UPSCALE_RENDITION,
+                 int interpolation = cv::INTER_LINEAR);
+
+    // Start a new frame; cached reference levels become stale
+    void setReference(const cv::Mat& reference);
+
+    // Produce the (reference, distorted) pair to score for one rendition.
+    // The outputs may alias internal buffers until the next call for the
+    // same rendition or the next setReference().
+    void align(size_t rendition, const cv::Mat& distorted,
+               cv::Mat& referenceOut, cv::Mat& distortedOut);
+
+    LadderScaleMode mode() const { return mode_; }
+
+private:
+    struct Level {
+        cv::Size size;
+        cv::Mat image;
+        bool valid;
+    };
+
+    LadderScaleMode mode_;
+    int interpolation_;
+    cv::Mat reference_;
+    std::vector<Level> levels_;
+    std::vector<cv::Mat> upscaled_;
+
+    const cv::Mat& referenceLevel(const cv::Size& size);
+};
+
+} // namespace VideoQuality
+
+#endif // LADDER_H
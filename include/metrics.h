@@ -1,5 +1,81 @@
+#ifndef METRICS_H
+#define METRICS_H
+
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <string>
+
+// Sample format traits: storage type plus the number of significant bits.
+// They fix the peak value, SSIM scaling and SSIM constants at compile time;
+// the pixel loops themselves are OpenCV's per-depth SIMD routines (norm on
+// 8U/16U, then convertTo/GaussianBlur on CV_32F for SSIM).
+template <typename T, int BitDepth>
+struct SampleTraits {
+    typedef T SampleType;
+    static const int depth = cv::DataType<T>::depth;
+    static const int bits = BitDepth;
+
+    static constexpr double peak() { return double((1 << BitDepth) - 1); }
+
+    // High bit depths are normalized to [0, 1] before SSIM to keep float precision
+    static constexpr double ssimScale() { return BitDepth > 8 ? 1.0 / peak() : 1.0; }
+    static constexpr double ssimC1() {
+        return (0.01 * peak() * ssimScale()) * (0.01 * peak() * ssimScale());
+    }
+    static constexpr double ssimC2() {
+        return (0.03 * peak() * ssimScale()) * (0.03 * peak() * ssimScale());
+    }
+};
+
+typedef SampleTraits<uchar, 8>   Sample8;
+typedef SampleTraits<ushort, 10> Sample10;
+typedef SampleTraits<ushort, 12> Sample12;
+typedef SampleTraits<ushort, 16> Sample16;
+
+// Per-tile quality grid for one frame. Set tileSize > 0 and pass to the
+// kernels; psnr/ssim are filled in place as tilesY x tilesX CV_32F grids
+// (edge tiles are clipped to the frame). SSIM is averaged over channels.
+struct TileMetrics {
+    int tileSize;
+    cv::Mat psnr;
+    cv::Mat ssim;
+
+    TileMetrics() : tileSize(0) {}
+    bool enabled() const { return tileSize > 0; }
+};
+
+// PSNR reported for tiles with no difference
+const double TILE_PSNR_MAX = 100.0;
+
+// Valid values for --bit-depth: 8, 10, 12 or 16
+bool isSupportedBitDepth(int bitDepth);
+
+// Significant bits of a frame: 8 for CV_8U, bitDepthHint (10/12/16) for CV_16U.
+// Throws when a hint of 8 meets a 16-bit frame.
+int resolveBitDepth(const cv::Mat& frame, int bitDepthHint = 0);
+
+// Open a capture that keeps the source sample depth when bitDepthHint > 8.
+// Backends that honour it (e.g. 16-bit PNG/TIFF image sequences) return
+// CV_16U frames; the rest still convert to 8-bit BGR, see keepsBitDepth().
+bool openCapture(cv::VideoCapture& capture, const std::string& path, int bitDepthHint = 0);
+
+// False when a bit depth above 8 was requested but the frame decoded as CV_8U
+bool keepsBitDepth(const cv::Mat& frame, int bitDepthHint);
+
+// False when a sample exceeds the peak of the resolved bit depth, e.g. full
+// range 16-bit samples declared as 10-bit
+bool fitsBitDepth(const cv::Mat& frame, int bitDepthHint);
+
+// Metrics parameterized by sample format (instantiated for Sample8/10/12/16)
+template <typename Traits>
+double getPSNR(const cv::Mat& I1, const cv::Mat& I2, TileMetrics* tiles = 0);
+template <typename Traits>
+cv::Scalar getMSSIM(const cv::Mat& i1, const cv::Mat& i2, TileMetrics* tiles = 0);
+
+// Runtime dispatch on the frame format
+double getPSNR(const cv::Mat& I1, const cv::Mat& I2, int bitDepthHint = 0,
+               TileMetrics* tiles = 0);
+cv::Scalar getMSSIM(const cv::Mat& i1, const cv::Mat& i2, int bitDepthHint = 0,
+                    TileMetrics* tiles = 0);
 
-double getPSNR(const cv::Mat& I1, const cv::Mat& I2);
-cv::Scalar getMSSIM(const cv::Mat& i1, const cv::Mat& i2);
\ No newline at end of file
+#endif // METRICS_H
@@ -0,0 +1,81 @@
+#ifndef TEMPORAL_H
+#define TEMPORAL_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <deque>
+
+namespace VideoQuality {
+
+// Fixed analysis resolution keeps the per-frame cost independent of video size
+const cv::Size TEMPORAL_THUMBNAIL_SIZE(160, 90);
+
+// Downscaled luma and 64-bit difference hash of one frame. The reference
+// frame is reduced once and shared by every rendition.
+struct TemporalFrame {
+    cv::Mat thumbnail;   // CV_32F luma on the 8-bit scale
+    uint64_t hash;       // dHash of a 9x8 reduction
+
+    TemporalFrame() : hash(0) {}
+};
+
+void computeTemporalFrame(const cv::Mat& frame, int bitDepthHint, TemporalFrame& out);
+
+// Incremental temporal metrics for one reference/distorted pair of streams.
+// Only the previous thumbnails and a short ring of hashes are kept, so each
+// update costs a few operations on 160x90 images.
+class TemporalAnalyzer {
+public:
+    enum FrameEvent {
+        FRAME_OK,
+        FRAME_DUPLICATED,   // distorted stream fell behind (repeated frames)
+        FRAME_DROPPED       // distorted stream skipped ahead (dropped frames)
+    };
+
+    // window: how many frames of drift are tracked; hashThreshold: maximum
+    // Hamming distance (of 64 bits) for two frames to count as the same picture
+    explicit TemporalAnalyzer(int window = 4, int hashThreshold = 6);
+
+    // Feed every decoded frame pair in order, including frames skipped by sampling
+    void update(const TemporalFrame& reference, const TemporalFrame& distorted);
+
+    // Most recent frame
+    double lastFlicker() const { return lastFlicker_; }
+    FrameEvent lastEvent() const { return lastEvent_; }
+
+    // Whole sequence (energies and flicker on the 8-bit scale)
+    int framePairs() const { return pairs_; }
+    double meanReferenceEnergy() const;
+    double meanDistortedEnergy() const;
+    double meanFlicker() const;
+    int duplicatedFrames() const { return duplicated_; }
+    int droppedFrames() const { return dropped_; }
+    int misalignedFrames() const { return misaligned_; }
+
+private:
+    int window_;
+    int hashThreshold_;
+
+    cv::Mat prevReference_, prevDistorted_;
+    cv::Mat referenceDelta_, distortedDelta_;
+    std::deque<uint64_t> referenceHashes_, distortedHashes_;   // newest first
+
+    int frames_;
+    int pairs_;
+    int lag_;   // >0: distorted shows older reference frames, <0: newer
+    double totalReferenceEnergy_, totalDistortedEnergy_, totalFlicker_;
+    int duplicated_, dropped_, misaligned_;
+    double lastFlicker_;
+    FrameEvent lastEvent_;
+
+    // Hamming distance between the streams at a given lag, -1 if not yet known
+    int lagCost(int lag, uint64_t referenceHash, uint64_t distortedHash) const;
+    // Moves the lag by one frame at most, and only when the reference changed,
+    // the repeated (or skipped) distorted frame explains it, and the new lag
+    // matches clearly better than the current one
+    void updateAlignment(uint64_t referenceHash, uint64_t distortedHash);
+};
+
+} // namespace VideoQuality
+
+#endif // TEMPORAL_H
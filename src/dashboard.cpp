@@ -1,4 +1,5 @@
 #include "dashboard.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -11,19 +12,37 @@ const std::string Dashboard::WIN_HEATMAP = "Difference Heatmap";
 const std::string Dashboard::WIN_CONTROLS = "Controls & Metrics";
 
 Dashboard::Dashboard(const std::string& originalPath,
-                     const std::string& compressedPath)
-    : currentFrame_(0), playing_(false), displayWidth_(640), 
+                     const std::string& compressedPath,
+                     int bitDepthHint)
+    : currentFrame_(0), bitDepthHint_(bitDepthHint), playing_(false),
+      lastTemporalFrame_(-1), displayWidth_(640), 
       displayHeight_(360), heatmapAlpha_(0.5), 
-      colormapType_(cv::COLORMAP_JET) {
+      colormapType_(cv::COLORMAP_JET), tileSize_(64), showTileMap_(true),
+      interpolation_(cv::INTER_LINEAR) {
     
     // Open videos
-    originalVideo_.open(originalPath);
-    compressedVideo_.open(compressedPath);
+    openCapture(originalVideo_, originalPath, bitDepthHint_);
+    openCapture(compressedVideo_, compressedPath, bitDepthHint_);
     
     if (!originalVideo_.isOpened() || !compressedVideo_.isOpened()) {
         throw std::runtime_error("Failed to open video files");
     }
     
+    // Refuse to silently score high bit depth content at 8 bits
+    cv::Mat probe;
+    originalVideo_.read(probe);
+    if (!probe.empty()) {
+        if (!keepsBitDepth(probe, bitDepthHint_)) {
+            throw std::runtime_error("High bit depth requested but the video backend decodes to 8 bits");
+        }
+        // resolveBitDepth() inside rejects --bit-depth 8 on 16-bit frames
+        if (!fitsBitDepth(probe, bitDepthHint_)) {
+            throw std::runtime_error("Samples exceed the peak of the requested bit depth");
+        }
+    }
+    originalVideo_.set(cv::CAP_PROP_POS_FRAMES, 0);
+    heatmapGen_.setBitDepth(bitDepthHint_);
+    
     // Get video properties
     totalFrames_ = static_cast<int>(originalVideo_.get(cv::CAP_PROP_FRAME_COUNT));
     fps_ = originalVideo_.get(cv::CAP_PROP_FPS);
@@ -39,6 +58,19 @@ Dashboard::~Dashboard() {
     cv::destroyAllWindows();
 }
 
+void Dashboard::setTileSize(int tileSize) {
+    tileSize_ = tileSize;
+}
+
+void Dashboard::setSSIMFloor(double ssimFloor) {
+    heatmapGen_.setSSIMFloor(ssimFloor);
+}
+
+void Dashboard::setInterpolation(int interpolation) {
+    interpolation_ = interpolation;
+    heatmapGen_.setInterpolation(interpolation);
+}
+
 void Dashboard::setupWindows() {
     cv::namedWindow(WIN_ORIGINAL, cv::WINDOW_AUTOSIZE);
     cv::namedWindow(WIN_COMPRESSED, cv::WINDOW_AUTOSIZE);
@@ -93,14 +125,31 @@ void Dashboard::calculateMetricsForFrame(int frameNum) {
     compressedVideo_.read(compFrame);
     
     if (!origFrame.empty() && !compFrame.empty()) {
+        FrameMetrics& m = metricsCache_[frameNum];
+        
+        // Temporal state only advances on the next consecutive frame, so
+        // recalculating or seeking never corrupts it
+        if (frameNum == lastTemporalFrame_ + 1) {
+            TemporalFrame origTemporal, compTemporal;
+            computeTemporalFrame(origFrame, bitDepthHint_, origTemporal);
+            computeTemporalFrame(compFrame, bitDepthHint_, compTemporal);
+            temporal_.update(origTemporal, compTemporal);
+            m.flicker = temporal_.lastFlicker();
+            m.event = temporal_.lastEvent();
+            lastTemporalFrame_ = frameNum;
+        }
+        
         // Resize if needed
         if (origFrame.size() != compFrame.size()) {
-            cv::resize(compFrame, compFrame, origFrame.size());
+            cv::resize(compFrame, compFrame, origFrame.size(), 0, 0, interpolation_);
         }
         
-        // Calculate metrics
-        metricsCache_[frameNum].psnr = getPSNR(origFrame, compFrame);
-        metricsCache_[frameNum].ssim = getMSSIM(origFrame, compFrame)[0];
+        // Calculate metrics (tile grids are filled in the same pass)
+        m.tiles.tileSize = tileSize_;
+        m.psnr = getPSNR(origFrame, compFrame, bitDepthHint_, &m.tiles);
+        // Channel mean, matching the tile grid and the CLI/export reports
+        cv::Scalar ssim = getMSSIM(origFrame, compFrame, bitDepthHint_, &m.tiles);
+        m.ssim = (ssim[0] + ssim[1] + ssim[2]) / std::max(1, origFrame.channels());
     }
 }
 
@@ -116,6 +165,8 @@ void Dashboard::precalculateMetrics() {
     }
     
     std::cout << "Metrics calculation complete." << std::endl;
+    std::cout << "Duplicated frames: " << temporal_.duplicatedFrames()
+              << ", dropped frames: " << temporal_.droppedFrames() << std::endl;
 }
 
 void Dashboard::drawMetrics(cv::Mat& panel, int yPos) {
@@ -124,12 +175,24 @@ void Dashboard::drawMetrics(cv::Mat& panel, int yPos) {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
     oss << "PSNR: " << metricsCache_[currentFrame_].psnr << " dB";
+    oss << "  Flicker: " << metricsCache_[currentFrame_].flicker;
+    if (metricsCache_[currentFrame_].event == TemporalAnalyzer::FRAME_DUPLICATED) {
+        oss << "  [DUPLICATED]";
+    } else if (metricsCache_[currentFrame_].event == TemporalAnalyzer::FRAME_DROPPED) {
+        oss << "  [DROPPED]";
+    }
     
     cv::putText(panel, oss.str(), cv::Point(10, yPos),
                 cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 255), 2);
     
+    const TileMetrics& tiles = metricsCache_[currentFrame_].tiles;
     oss.str("");
     oss << "SSIM: " << metricsCache_[currentFrame_].ssim;
+    if (!tiles.ssim.empty()) {
+        double worstSSIM;
+        cv::minMaxLoc(tiles.ssim, &worstSSIM);
+        oss << std::setprecision(4) << "  (worst tile: " << worstSSIM << ")";
+    }
     cv::putText(panel, oss.str(), cv::Point(10, yPos + 30),
                 cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 255), 2);
 }
@@ -158,7 +221,7 @@ void Dashboard::drawTimeline(cv::Mat& panel, int yPos) {
 }
 
 void Dashboard::drawControlPanel(cv::Mat& panel) {
-    panel = cv::Mat::zeros(300, 640, CV_8UC3);
+    panel = cv::Mat::zeros(330, 640, CV_8UC3);
     
     // Title
     cv::putText(panel, "Video Quality Dashboard", cv::Point(10, 30),
@@ -171,7 +234,8 @@ void Dashboard::drawControlPanel(cv::Mat& panel) {
         "LEFT: Previous Frame",
         "Q/ESC: Quit",
         "H: Toggle Heatmap Overlay",
-        "C: Change Colormap"
+        "C: Change Colormap",
+        "M: Toggle SSIM Tile Map / Pixel Difference"
     };
     
     int yPos = 70;
@@ -182,10 +246,10 @@ void Dashboard::drawControlPanel(cv::Mat& panel) {
     }
     
     // Metrics
-    drawMetrics(panel, 200);
+    drawMetrics(panel, 220);
     
     // Timeline
-    drawTimeline(panel, 250);
+    drawTimeline(panel, 280);
 }
 
 void Dashboard::updateDisplay() {
@@ -205,9 +269,14 @@ void Dashboard::updateDisplay() {
     cv::resize(origFrame, origDisplay, cv::Size(displayWidth_, displayHeight_));
     cv::resize(compFrame, compDisplay, cv::Size(displayWidth_, displayHeight_));
     
-    // Generate heatmap
-    cv::Mat heatmap = heatmapGen_.generateOverlay(origFrame, compFrame, 
-                                                   heatmapAlpha_, colormapType_);
+    // Generate heatmap, preferring the cached SSIM tile map
+    const TileMetrics& tiles = metricsCache_[currentFrame_].tiles;
+    bool useTiles = showTileMap_ && !tiles.ssim.empty();
+    cv::Mat heatmap = useTiles
+        ? heatmapGen_.generateTileOverlay(origFrame, tiles.ssim,
+                                          heatmapAlpha_, colormapType_)
+        : heatmapGen_.generateOverlay(origFrame, compFrame,
+                                      heatmapAlpha_, colormapType_);
     cv::Mat heatmapDisplay;
     cv::resize(heatmap, heatmapDisplay, cv::Size(displayWidth_, displayHeight_));
     
@@ -216,7 +285,7 @@ void Dashboard::updateDisplay() {
                 cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
     cv::putText(compDisplay, "Compressed", cv::Point(10, 30),
                 cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
-    cv::putText(heatmapDisplay, "Difference", cv::Point(10, 30),
+    cv::putText(heatmapDisplay, useTiles ? "SSIM Tiles" : "Difference", cv::Point(10, 30),
                 cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 2);
     
     // Display
@@ -259,6 +328,11 @@ void Dashboard::handleKeyPress(int key) {
                            cv::COLORMAP_HOT : cv::COLORMAP_JET;
             updateDisplay();
             break;
+        case 'm':
+        case 'M':
+            showTileMap_ = !showTileMap_;
+            updateDisplay();
+            break;
     }
 }
 
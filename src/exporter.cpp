@@ -0,0 +1,275 @@
+#include "exporter.h"
+#include "frame_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace VideoQuality {
+
+ComparisonExporter::Options::Options()
+    : panelWidth(640), heatmapAlpha(0.5), colormapType(cv::COLORMAP_JET),
+      tileSize(64), ssimFloor(0.7), interpolation(cv::INTER_LINEAR),
+      bitDepthHint(0), renderThreads(0), fourcc("mp4v") {}
+
+ComparisonExporter::ComparisonExporter(const std::string& originalPath,
+                                       const std::string& compressedPath,
+                                       const Options& options)
+    : options_(options) {
+
+    // Open videos
+    openCapture(originalVideo_, originalPath, options_.bitDepthHint);
+    openCapture(compressedVideo_, compressedPath, options_.bitDepthHint);
+
+    if (!originalVideo_.isOpened() || !compressedVideo_.isOpened()) {
+        throw std::runtime_error("Failed to open video files");
+    }
+
+    // Get video properties
+    totalFrames_ = static_cast<int>(originalVideo_.get(cv::CAP_PROP_FRAME_COUNT));
+    fps_ = originalVideo_.get(cv::CAP_PROP_FPS);
+    if (fps_ <= 0) fps_ = 25.0;
+
+    int width = static_cast<int>(originalVideo_.get(cv::CAP_PROP_FRAME_WIDTH));
+    int height = static_cast<int>(originalVideo_.get(cv::CAP_PROP_FRAME_HEIGHT));
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("Cannot determine video resolution");
+    }
+
+    // Panels keep the source aspect ratio; even sizes keep 4:2:0 output valid
+    int panelWidth = std::max(2, options_.panelWidth & ~1);
+    int panelHeight = std::max(2, cvRound(panelWidth * double(height) / width) & ~1);
+    panelSize_ = cv::Size(panelWidth, panelHeight);
+    outputSize_ = cv::Size(3 * panelWidth, panelHeight + BANNER_HEIGHT);
+}
+
+cv::Mat ComparisonExporter::toDisplay(const cv::Mat& frame) const {
+    cv::Mat display = frame;
+    if (frame.depth() != CV_8U) {
+        int bits = resolveBitDepth(frame, options_.bitDepthHint);
+        frame.convertTo(display, CV_8U, 255.0 / ((1 << bits) - 1));
+    }
+    if (display.channels() == 1) {
+        cv::cvtColor(display, display, cv::COLOR_GRAY2BGR);
+    }
+    return display;
+}
+
+cv::Mat ComparisonExporter::renderFrame(const FramePair& pair,
+                                        HeatmapGenerator& heatmapGen) {
+    // Ensure same size
+    cv::Mat compressed;
+    if (pair.original.size() != pair.compressed.size()) {
+        cv::resize(pair.compressed, compressed, pair.original.size(), 0, 0,
+                   options_.interpolation);
+    } else {
+        compressed = pair.compressed;
+    }
+
+    // Metrics; the SSIM tile grid doubles as the heatmap source
+    TileMetrics tiles;
+    tiles.tileSize = options_.tileSize;
+    double psnr = getPSNR(pair.original, compressed, options_.bitDepthHint, &tiles);
+    cv::Scalar ssim = getMSSIM(pair.original, compressed, options_.bitDepthHint, &tiles);
+
+    cv::Mat overlay = tiles.enabled()
+        ? heatmapGen.generateTileOverlay(pair.original, tiles.ssim,
+                                         options_.heatmapAlpha, options_.colormapType)
+        : heatmapGen.generateOverlay(pair.original, compressed,
+                                     options_.heatmapAlpha, options_.colormapType);
+
+    // Compose panels
+    cv::Mat canvas(outputSize_, CV_8UC3, cv::Scalar::all(0));
+    const cv::Mat panels[3] = { toDisplay(pair.original), toDisplay(compressed), overlay };
+    const char* labels[3] = { "Original", "Compressed",
+                              tiles.enabled() ? "SSIM Tiles" : "Difference" };
+    for (int i = 0; i < 3; ++i) {
+        cv::Mat roi = canvas(cv::Rect(i * panelSize_.width, 0,
+                                      panelSize_.width, panelSize_.height));
+        cv::resize(panels[i], roi, panelSize_, 0, 0, cv::INTER_AREA);
+        cv::putText(roi, labels[i], cv::Point(10, 30),
+                    cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
+    }
+
+    // Metrics banner
+    std::ostringstream oss;
+    oss << "Frame " << pair.index + 1 << " / " << totalFrames_
+        << std::fixed << std::setprecision(2) << "   PSNR: " << psnr << " dB"
+        << std::setprecision(4) << "   SSIM: "
+        << (ssim[0] + ssim[1] + ssim[2]) / std::max(1, pair.original.channels());
+    if (tiles.enabled()) {
+        double worstSSIM;
+        cv::minMaxLoc(tiles.ssim, &worstSSIM);
+        oss << "   Worst tile SSIM: " << worstSSIM;
+    }
+    cv::putText(canvas, oss.str(), cv::Point(10, panelSize_.height + 27),
+                cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 255), 2);
+
+    return canvas;
+}
+
+static bool hasSuffix(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static void writeY4MHeader(std::ostream& out, const cv::Size& size, double fps) {
+    out << "YUV4MPEG2 W" << size.width << " H" << size.height
+        << " F" << cvRound(fps * 1000) << ":1000 Ip A1:1 C420jpeg\n";
+}
+
+static void writeY4MFrame(std::ostream& out, const cv::Mat& bgr) {
+    cv::Mat yuv;
+    cv::cvtColor(bgr, yuv, cv::COLOR_BGR2YUV_I420);
+    out << "FRAME\n";
+    out.write(reinterpret_cast<const char*>(yuv.data), yuv.total());
+}
+
+int ComparisonExporter::run(const std::string& outputPath) {
+    // Open output
+    bool rawY4M = hasSuffix(outputPath, ".y4m");
+    std::ofstream y4mOut;
+    cv::VideoWriter writer;
+    if (rawY4M) {
+        y4mOut.open(outputPath.c_str(), std::ios::binary);
+        if (y4mOut) writeY4MHeader(y4mOut, outputSize_, fps_);
+    } else if (options_.fourcc.size() == 4) {
+        const std::string& cc = options_.fourcc;
+        writer.open(outputPath, cv::VideoWriter::fourcc(cc[0], cc[1], cc[2], cc[3]),
+                    fps_, outputSize_);
+    }
+    if (rawY4M ? !y4mOut : !writer.isOpened()) {
+        throw std::runtime_error("Failed to open output video: " + outputPath);
+    }
+
+    int workers = options_.renderThreads;
+    if (workers <= 0) {
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 2);
+    }
+
+    std::cout << "Exporting " << outputSize_.width << "x" << outputSize_.height
+              << " to " << outputPath << " (" << workers << " render threads)" << std::endl;
+
+    FrameQueue<FramePair> decoded(2 * workers);
+    FrameQueue<RenderedFrame> rendered(2 * workers);
+
+    // First failure wins; closing both queues unwinds every stage
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = e;
+        }
+        decoded.close();
+        rendered.close();
+    };
+
+    // Decode stage
+    std::thread decoder([&]() {
+        try {
+            for (int index = 0; ; ++index) {
+                FramePair pair;
+                pair.index = index;
+                if (!originalVideo_.read(pair.original) ||
+                    !compressedVideo_.read(pair.compressed)) break;
+                if (pair.original.empty() || pair.compressed.empty()) break;
+                if (index == 0) {
+                    if (!keepsBitDepth(pair.original, options_.bitDepthHint)) {
+                        throw std::runtime_error(
+                            "High bit depth requested but the video backend decodes to 8 bits");
+                    }
+                    if (!fitsBitDepth(pair.original, options_.bitDepthHint) ||
+                        !fitsBitDepth(pair.compressed, options_.bitDepthHint)) {
+                        throw std::runtime_error(
+                            "Samples exceed the peak of the requested bit depth");
+                    }
+                }
+                if (!decoded.push(std::move(pair))) break;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        decoded.close();
+    });
+
+    // Render stage; frames may complete out of order
+    std::atomic<int> activeRenderers(workers);
+    std::vector<std::thread> renderers;
+    for (int i = 0; i < workers; ++i) {
+        renderers.push_back(std::thread([&]() {
+            HeatmapGenerator heatmapGen;
+            heatmapGen.setBitDepth(options_.bitDepthHint);
+            heatmapGen.setSSIMFloor(options_.ssimFloor);
+            heatmapGen.setInterpolation(options_.interpolation);
+            try {
+                FramePair pair;
+                while (decoded.pop(pair)) {
+                    RenderedFrame frame;
+                    frame.index = pair.index;
+                    frame.image = renderFrame(pair, heatmapGen);
+                    if (!rendered.push(std::move(frame))) break;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            if (--activeRenderers == 0) rendered.close();
+        }));
+    }
+
+    // Encode stage on this thread, restoring frame order
+    std::map<int, cv::Mat> pending;
+    int nextIndex = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    try {
+        RenderedFrame frame;
+        while (rendered.pop(frame)) {
+            pending[frame.index] = frame.image;
+            std::map<int, cv::Mat>::iterator it = pending.begin();
+            while (it != pending.end() && it->first == nextIndex) {
+                if (rawY4M) {
+                    writeY4MFrame(y4mOut, it->second);
+                } else {
+                    writer.write(it->second);
+                }
+                it = pending.erase(it);
+                ++nextIndex;
+
+                if (nextIndex % 30 == 0) {
+                    double elapsed = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - startTime).count();
+                    std::cout << "\r  Frame " << nextIndex << "/" << totalFrames_
+                              << " | " << std::fixed << std::setprecision(1)
+                              << nextIndex / std::max(elapsed, 1e-3) << " fps      "
+                              << std::flush;
+                }
+            }
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+    std::cout << std::endl;
+
+    decoder.join();
+    for (size_t i = 0; i < renderers.size(); ++i) {
+        renderers[i].join();
+    }
+
+    if (error) std::rethrow_exception(error);
+    if (rawY4M && !y4mOut) {
+        throw std::runtime_error("Failed writing output video: " + outputPath);
+    }
+
+    return nextIndex;
+}
+
+} // namespace VideoQuality
@@ -1,9 +1,12 @@
 #include "heatmap.h"
+#include "metrics.h"
+#include <algorithm>
 #include <iostream>
 
 namespace VideoQuality {
 
-HeatmapGenerator::HeatmapGenerator() : threshold_(10.0) {}
+HeatmapGenerator::HeatmapGenerator()
+    : threshold_(10.0), ssimFloor_(0.7), bitDepth_(16), interpolation_(cv::INTER_LINEAR) {}
 
 cv::Mat HeatmapGenerator::calculateDifference(const cv::Mat& img1, 
                                               const cv::Mat& img2) {
@@ -32,23 +35,24 @@ cv::Mat HeatmapGenerator::normalizeForDisplay(const cv::Mat& diff) {
     return normalized;
 }
 
-cv::Mat HeatmapGenerator::generateHeatmap(const cv::Mat& original,
-                                          const cv::Mat& compressed,
-                                          int colormapType) {
+template <typename Traits>
+cv::Mat HeatmapGenerator::generateHeatmapImpl(const cv::Mat& original,
+                                              const cv::Mat& compressed,
+                                              int colormapType) {
     // Ensure same size
-    cv::Mat comp_resized;
+    cv::Mat comp_resized = compressed;
     if (original.size() != compressed.size()) {
-        cv::resize(compressed, comp_resized, original.size());
-    } else {
-        comp_resized = compressed.clone();
+        cv::resize(compressed, resized_, original.size(), 0, 0, interpolation_);
+        comp_resized = resized_;
     }
     
     // Calculate difference
     cv::Mat diff = calculateDifference(original, comp_resized);
     
-    // Apply threshold
+    // Apply threshold (threshold_ is given on the 8-bit scale)
     cv::Mat thresholded;
-    cv::threshold(diff, thresholded, threshold_, 255, cv::THRESH_TOZERO);
+    double thresh = threshold_ * Traits::peak() / 255.0;
+    cv::threshold(diff, thresholded, thresh, Traits::peak(), cv::THRESH_TOZERO);
     
     // Normalize for display
     cv::Mat normalized = normalizeForDisplay(thresholded);
@@ -60,19 +64,33 @@ cv::Mat HeatmapGenerator::generateHeatmap(const cv::Mat& original,
     return heatmap;
 }
 
-cv::Mat HeatmapGenerator::generateOverlay(const cv::Mat& original,
-                                          const cv::Mat& compressed,
-                                          double alpha,
-                                          int colormapType) {
+template <typename Traits>
+cv::Mat HeatmapGenerator::generateOverlayImpl(const cv::Mat& original,
+                                              const cv::Mat& compressed,
+                                              double alpha,
+                                              int colormapType) {
     // Generate heatmap
-    cv::Mat heatmap = generateHeatmap(original, compressed, colormapType);
+    cv::Mat heatmap = generateHeatmapImpl<Traits>(original, compressed, colormapType);
+    
+    return blendOverlay(original, heatmap, alpha, Traits::peak());
+}
+
+cv::Mat HeatmapGenerator::blendOverlay(const cv::Mat& original, cv::Mat heatmap,
+                                       double alpha, double peak) {
+    // Bring original down to 8-bit display range
+    cv::Mat orig_display;
+    if (original.depth() != CV_8U) {
+        original.convertTo(orig_display, CV_8U, 255.0 / peak);
+    } else {
+        orig_display = original;
+    }
     
     // Convert original to color if grayscale
     cv::Mat orig_color;
-    if (original.channels() == 1) {
-        cv::cvtColor(original, orig_color, cv::COLOR_GRAY2BGR);
+    if (orig_display.channels() == 1) {
+        cv::cvtColor(orig_display, orig_color, cv::COLOR_GRAY2BGR);
     } else {
-        orig_color = original.clone();
+        orig_color = orig_display;
     }
     
     // Ensure same size
@@ -87,15 +105,57 @@ cv::Mat HeatmapGenerator::generateOverlay(const cv::Mat& original,
     return overlay;
 }
 
+cv::Mat HeatmapGenerator::generateTileOverlay(const cv::Mat& original,
+                                              const cv::Mat& ssimTiles,
+                                              double alpha,
+                                              int colormapType) {
+    // Fixed scale: SSIM 1.0 maps to 0 and the floor (or worse) to 255, then
+    // the threshold (on that 0-255 scale) hides near-perfect tiles
+    double scale = 255.0 / (1.0 - ssimFloor_);
+    cv::Mat normalized;
+    ssimTiles.convertTo(normalized, CV_8U, -scale, scale);
+    cv::threshold(normalized, normalized, threshold_, 255, cv::THRESH_TOZERO);
+    
+    // Nearest-neighbour upscale keeps tile boundaries crisp
+    cv::Mat tileHeatmap, heatmap;
+    cv::applyColorMap(normalized, tileHeatmap, colormapType);
+    cv::resize(tileHeatmap, heatmap, original.size(), 0, 0, cv::INTER_NEAREST);
+    
+    int bits = resolveBitDepth(original, bitDepth_);
+    return blendOverlay(original, heatmap, alpha, double((1 << bits) - 1));
+}
+
+cv::Mat HeatmapGenerator::generateHeatmap(const cv::Mat& original,
+                                          const cv::Mat& compressed,
+                                          int colormapType) {
+    switch (resolveBitDepth(original, bitDepth_)) {
+        case 10: return generateHeatmapImpl<Sample10>(original, compressed, colormapType);
+        case 12: return generateHeatmapImpl<Sample12>(original, compressed, colormapType);
+        case 16: return generateHeatmapImpl<Sample16>(original, compressed, colormapType);
+        default: return generateHeatmapImpl<Sample8>(original, compressed, colormapType);
+    }
+}
+
+cv::Mat HeatmapGenerator::generateOverlay(const cv::Mat& original,
+                                          const cv::Mat& compressed,
+                                          double alpha,
+                                          int colormapType) {
+    switch (resolveBitDepth(original, bitDepth_)) {
+        case 10: return generateOverlayImpl<Sample10>(original, compressed, alpha, colormapType);
+        case 12: return generateOverlayImpl<Sample12>(original, compressed, alpha, colormapType);
+        case 16: return generateOverlayImpl<Sample16>(original, compressed, alpha, colormapType);
+        default: return generateOverlayImpl<Sample8>(original, compressed, alpha, colormapType);
+    }
+}
+
 HeatmapGenerator::DifferenceStats 
 HeatmapGenerator::calculateStats(const cv::Mat& original,
                                 const cv::Mat& compressed) {
     // Ensure same size
-    cv::Mat comp_resized;
+    cv::Mat comp_resized = compressed;
     if (original.size() != compressed.size()) {
-        cv::resize(compressed, comp_resized, original.size());
-    } else {
-        comp_resized = compressed.clone();
+        cv::resize(compressed, resized_, original.size(), 0, 0, interpolation_);
+        comp_resized = resized_;
     }
     
     // Calculate difference
@@ -117,4 +177,16 @@ void HeatmapGenerator::setThreshold(double threshold) {
     threshold_ = threshold;
 }
 
+void HeatmapGenerator::setSSIMFloor(double ssimFloor) {
+    ssimFloor_ = std::min(ssimFloor, 0.99);
+}
+
+void HeatmapGenerator::setBitDepth(int bitDepth) {
+    bitDepth_ = bitDepth;
+}
+
+void HeatmapGenerator::setInterpolation(int interpolation) {
+    interpolation_ = interpolation;
+}
+
 } // namespace VideoQuality
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ladder.h"
+
+namespace VideoQuality {
+
+int parseScaler(const std::string& name) {
+    // All of these run through cv::resize's SIMD paths
+    if (name == "nearest") return cv::INTER_NEAREST;
+    if (name == "bilinear") return cv::INTER_LINEAR;
+    if (name == "bicubic") return cv::INTER_CUBIC;
+    if (name == "area") return cv::INTER_AREA;
+    if (name == "lanczos") return cv::INTER_LANCZOS4;
+    return -1;
+}
+
+LadderScaler::LadderScaler(LadderScaleMode mode, int interpolation)
+    : mode_(mode), interpolation_(interpolation) {}
+
+void LadderScaler::setReference(const cv::Mat& reference) {
+    reference_ = reference;
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        levels_[i].valid = false;
+    }
+}
+
+const cv::Mat& LadderScaler::referenceLevel(const cv::Size& size) {
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        Level& level = levels_[i];
+        if (level.size == size) {
+            // Same size as last frame: resize reuses the existing buffer
+            if (!level.valid) {
+                cv::resize(reference_, level.image, size, 0, 0, interpolation_);
+                level.valid = true;
+            }
+            return level.image;
+        }
+    }
+
+    Level level;
+    level.size = size;
+    cv::resize(reference_, level.image, size, 0, 0, interpolation_);
+    level.valid = true;
+    levels_.push_back(level);
+    return levels_.back().image;
+}
+
+void LadderScaler::align(size_t rendition, const cv::Mat& distorted,
+                         cv::Mat& referenceOut, cv::Mat& distortedOut) {
+    if (distorted.size() == reference_.size()) {
+        referenceOut = reference_;
+        distortedOut = distorted;
+        return;
+    }
+
+    if (mode_ == LADDER_DOWNSCALE_REFERENCE) {
+        referenceOut = referenceLevel(distorted.size());
+        distortedOut = distorted;
+        return;
+    }
+
+    if (upscaled_.size() <= rendition) {
+        upscaled_.resize(rendition + 1);
+    }
+    cv::resize(distorted, upscaled_[rendition], reference_.size(), 0, 0, interpolation_);
+    referenceOut = reference_;
+    distortedOut = upscaled_[rendition];
+}
+
+} // namespace VideoQuality
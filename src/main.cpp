@@ -2,21 +2,203 @@
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
 #include "metrics.h"
+#include "ladder.h"
+#include "temporal.h"
 
 using namespace cv;
 using namespace std;
+using namespace VideoQuality;
 
-int main(int argc, char** argv) {
-    if (argc != 3) {
-        cout << "Usage: ./metrics <original_video> <compressed_video>" << endl;
+// Running totals for one compressed rendition
+struct Rendition {
+    string path;
+    VideoCapture video;
+    Mat frame;
+    TileMetrics tiles;
+    TemporalFrame temporalFrame;
+    TemporalAnalyzer temporal;
+
+    double totalPSNR;
+    Scalar totalSSIM;
+    double lastPSNR;
+
+    // Worst-tile statistics (only with --tile-size)
+    double totalWorstTileSSIM;
+    double worstTileSSIM, worstTilePSNR;
+    int worstSSIMFrame, worstPSNRFrame;
+    Point worstSSIMTile, worstPSNRTile;
+    vector<Mat> ssimTileGrids;   // one CV_8U grid per processed frame, SSIM * 255
+
+    Rendition()
+        : totalPSNR(0.0), totalSSIM(0, 0, 0, 0), lastPSNR(0.0),
+          totalWorstTileSSIM(0.0), worstTileSSIM(1.0), worstTilePSNR(TILE_PSNR_MAX),
+          worstSSIMFrame(0), worstPSNRFrame(0) {}
+};
+
+static void printUsage() {
+    cout << "Usage: ./metrics <original_video> <compressed_video> [more_renditions...] [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "  --bit-depth <8|10|12|16>  Significant bits of 16-bit frames (default 16)" << endl;
+    cout << "  --tile-size <N>           Per-tile PSNR/SSIM on NxN tiles, report worst tiles" << endl;
+    cout << "  --scale <up|down>         Upscale renditions to the original (default) or" << endl;
+    cout << "                            score against a downscaled original" << endl;
+    cout << "  --scaler <name>           nearest, bilinear (default), bicubic, area, lanczos" << endl;
+    cout << "  --temporal                Frame-difference energy, flicker and duplicated/dropped frames" << endl;
+}
+
+static void accumulateTiles(Rendition& r, int frameCount) {
+    double frameWorstSSIM, frameWorstPSNR;
+    Point ssimLoc, psnrLoc;
+    minMaxLoc(r.tiles.ssim, &frameWorstSSIM, 0, &ssimLoc);
+    minMaxLoc(r.tiles.psnr, &frameWorstPSNR, 0, &psnrLoc);
+    r.totalWorstTileSSIM += frameWorstSSIM;
+
+    // Keep every frame's grid, quantized to 8 bits (a few hundred bytes per frame)
+    Mat grid;
+    r.tiles.ssim.convertTo(grid, CV_8U, 255.0);
+    r.ssimTileGrids.push_back(grid);
+    if (frameWorstSSIM < r.worstTileSSIM) {
+        r.worstTileSSIM = frameWorstSSIM;
+        r.worstSSIMFrame = frameCount;
+        r.worstSSIMTile = ssimLoc;
+    }
+    if (frameWorstPSNR < r.worstTilePSNR) {
+        r.worstTilePSNR = frameWorstPSNR;
+        r.worstPSNRFrame = frameCount;
+        r.worstPSNRTile = psnrLoc;
+    }
+}
+
+// SSIM below which the given fraction of all stored tiles fall
+static double tileSSIMPercentile(const Rendition& r, double fraction) {
+    vector<size_t> histogram(256, 0);
+    size_t count = 0;
+    for (size_t i = 0; i < r.ssimTileGrids.size(); ++i) {
+        const Mat& grid = r.ssimTileGrids[i];
+        for (int y = 0; y < grid.rows; ++y) {
+            const uchar* row = grid.ptr<uchar>(y);
+            for (int x = 0; x < grid.cols; ++x) ++histogram[row[x]];
+        }
+        count += grid.total();
+    }
+    size_t target = static_cast<size_t>(fraction * count);
+    size_t seen = 0;
+    for (int v = 0; v < 256; ++v) {
+        seen += histogram[v];
+        if (seen > target) return v / 255.0;
+    }
+    return 1.0;
+}
+
+static void printResults(const Rendition& r, int processedFrames, int totalFrames,
+                         bool named, bool temporal) {
+    double avgPSNR = r.totalPSNR / processedFrames;
+    double avgSSIM = (r.totalSSIM[0] + r.totalSSIM[1] + r.totalSSIM[2]) / (3 * processedFrames);
+
+    // Output results in the format expected by batch_eval.sh
+    cout << "Results:";
+    if (named) cout << " " << r.path;
+    cout << endl;
+    cout << "  Frames processed: " << processedFrames << " of " << totalFrames << endl;
+    cout << "  Average PSNR: " << fixed << setprecision(2) << avgPSNR << " dB" << endl;
+    cout << "  Average SSIM: " << fixed << setprecision(4) << avgSSIM << endl;
+
+    if (r.tiles.enabled()) {
+        cout << "Tiles (" << r.tiles.tileSize << "x" << r.tiles.tileSize << "):" << endl;
+        cout << "  Mean worst-tile SSIM: " << setprecision(4)
+             << r.totalWorstTileSSIM / processedFrames << endl;
+        cout << "  5th percentile tile SSIM: " << tileSSIMPercentile(r, 0.05) << endl;
+        cout << "  Worst-tile SSIM: " << r.worstTileSSIM
+             << " (frame " << r.worstSSIMFrame << ", tile " << r.worstSSIMTile.x
+             << "," << r.worstSSIMTile.y << ")" << endl;
+        cout << "  Worst-tile PSNR: " << setprecision(2) << r.worstTilePSNR << " dB"
+             << " (frame " << r.worstPSNRFrame << ", tile " << r.worstPSNRTile.x
+             << "," << r.worstPSNRTile.y << ")" << endl;
+    }
+
+    if (temporal) {
+        const TemporalAnalyzer& t = r.temporal;
+        cout << "Temporal (" << t.framePairs() << " frame pairs):" << endl;
+        cout << "  Original frame-difference energy: " << setprecision(2)
+             << t.meanReferenceEnergy() << endl;
+        cout << "  Compressed frame-difference energy: " << t.meanDistortedEnergy() << endl;
+        cout << "  Flicker index: " << setprecision(3) << t.meanFlicker() << endl;
+        cout << "  Duplicated frames: " << t.duplicatedFrames() << endl;
+        cout << "  Dropped frames: " << t.droppedFrames() << endl;
+        cout << "  Misaligned frames: " << t.misalignedFrames() << endl;
+    }
+}
+
+static int run(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
         return -1;
     }
 
-    VideoCapture refVideo(argv[1]);
-    VideoCapture distVideo(argv[2]);
+    int bitDepthHint = 0;
+    int tileSize = 0;
+    LadderScaleMode scaleMode = LADDER_UPSCALE_RENDITION;
+    int interpolation = INTER_LINEAR;
+    bool temporal = false;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            paths.push_back(arg);
+        } else if (arg == "--bit-depth" && i + 1 < argc) {
+            bitDepthHint = atoi(argv[++i]);
+            if (!isSupportedBitDepth(bitDepthHint)) {
+                cerr << "Error: Unsupported bit depth " << bitDepthHint << endl;
+                return -1;
+            }
+        } else if (arg == "--tile-size" && i + 1 < argc) {
+            tileSize = atoi(argv[++i]);
+            if (tileSize <= 0) {
+                cerr << "Error: Tile size must be positive" << endl;
+                return -1;
+            }
+        } else if (arg == "--scale" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "up") {
+                scaleMode = LADDER_UPSCALE_RENDITION;
+            } else if (mode == "down") {
+                scaleMode = LADDER_DOWNSCALE_REFERENCE;
+            } else {
+                cerr << "Error: Unknown scale mode " << mode << endl;
+                return -1;
+            }
+        } else if (arg == "--temporal") {
+            temporal = true;
+        } else if (arg == "--scaler" && i + 1 < argc) {
+            interpolation = parseScaler(argv[++i]);
+            if (interpolation < 0) {
+                cerr << "Error: Unknown scaler " << argv[i] << endl;
+                return -1;
+            }
+        } else {
+            printUsage();
+            return -1;
+        }
+    }
+    if (paths.size() < 2) {
+        printUsage();
+        return -1;
+    }
 
-    if (!refVideo.isOpened() || !distVideo.isOpened()) {
+    VideoCapture refVideo;
+    vector<Rendition> renditions(paths.size() - 1);
+    bool opened = openCapture(refVideo, paths[0], bitDepthHint);
+    for (size_t r = 0; r < renditions.size(); ++r) {
+        renditions[r].path = paths[r + 1];
+        renditions[r].tiles.tileSize = tileSize;
+        opened = openCapture(renditions[r].video, paths[r + 1], bitDepthHint) && opened;
+    }
+
+    if (!opened) {
         cerr << "Error: Cannot open video files." << endl;
         return -1;
     }
@@ -49,42 +231,107 @@ int main(int argc, char** argv) {
 
     cout << "Processing..." << endl;
 
-    Mat refFrame, distFrame;
+    if (renditions.size() > 1) {
+        cout << "Ladder: " << renditions.size() << " renditions, "
+             << (scaleMode == LADDER_UPSCALE_RENDITION ? "upscaled to original"
+                                                       : "against downscaled original")
+             << endl;
+    }
+
+    Mat refFrame, refAligned, distAligned;
+    LadderScaler scaler(scaleMode, interpolation);
+    TemporalFrame refTemporal;
     int frameCount = 0;
     int processedFrames = 0;
-    double totalPSNR = 0.0;
-    Scalar totalSSIM = Scalar(0, 0, 0, 0);
 
     auto startTime = chrono::high_resolution_clock::now();
 
     while (true) {
-        bool refOk = refVideo.read(refFrame);
-        bool distOk = distVideo.read(distFrame);
+        // Renditions are decoded in lockstep with the original
+        bool ok = refVideo.read(refFrame);
+        for (size_t r = 0; r < renditions.size() && ok; ++r) {
+            ok = renditions[r].video.read(renditions[r].frame);
+        }
         
-        if (!refOk || !distOk) break;
+        if (!ok) break;
         
         frameCount++;
+
+        bool empty = refFrame.empty();
+        for (size_t r = 0; r < renditions.size(); ++r) {
+            empty = empty || renditions[r].frame.empty();
+        }
+        if (empty) {
+            cerr << "Warning: Empty frame at position " << frameCount << endl;
+            break;
+        }
+
+        // Validate the sample format on the first decoded frame, before any
+        // kernel (temporal included) sees it
+        if (frameCount == 1) {
+            for (size_t r = 0; r < renditions.size(); ++r) {
+                if (refFrame.type() != renditions[r].frame.type()) {
+                    cerr << "Error: Original and compressed sample formats differ" << endl;
+                    return -1;
+                }
+            }
+            if (!keepsBitDepth(refFrame, bitDepthHint)) {
+                cerr << "Error: --bit-depth " << bitDepthHint
+                     << " requested but the video backend decodes to 8 bits." << endl;
+                cerr << "Convert to a 16-bit image sequence first, e.g.:" << endl;
+                cerr << "  ffmpeg -i input.mkv -pix_fmt rgb48be frames_%05d.png" << endl;
+                return -1;
+            }
+            if (bitDepthHint == 8 && refFrame.depth() == CV_16U) {
+                cerr << "Error: --bit-depth 8 given for 16-bit frames (use 10, 12 or 16)" << endl;
+                return -1;
+            }
+            bool fits = fitsBitDepth(refFrame, bitDepthHint);
+            for (size_t r = 0; r < renditions.size(); ++r) {
+                fits = fits && fitsBitDepth(renditions[r].frame, bitDepthHint);
+            }
+            if (!fits) {
+                cerr << "Error: Samples exceed the " << resolveBitDepth(refFrame, bitDepthHint)
+                     << "-bit peak; check --bit-depth (full range 16-bit frames need 16)" << endl;
+                return -1;
+            }
+            cout << "  Sample format: " << resolveBitDepth(refFrame, bitDepthHint)
+                 << "-bit, " << refFrame.channels() << " channel(s)" << endl;
+        }
+
+        // Temporal metrics see every decoded frame, including sampled-out ones;
+        // the original's thumbnail is shared by all renditions
+        if (temporal) {
+            computeTemporalFrame(refFrame, bitDepthHint, refTemporal);
+            for (size_t r = 0; r < renditions.size(); ++r) {
+                Rendition& rend = renditions[r];
+                computeTemporalFrame(rend.frame, bitDepthHint, rend.temporalFrame);
+                rend.temporal.update(refTemporal, rend.temporalFrame);
+            }
+        }
         
         // Skip frames if sampling
         if ((frameCount - 1) % skipFrames != 0) {
             continue;
         }
 
-        if (refFrame.empty() || distFrame.empty()) {
-            cerr << "Warning: Empty frame at position " << frameCount << endl;
-            break;
-        }
+        // Reference levels are scaled at most once per frame for all renditions
+        scaler.setReference(refFrame);
+        for (size_t r = 0; r < renditions.size(); ++r) {
+            Rendition& rend = renditions[r];
+            scaler.align(r, rend.frame, refAligned, distAligned);
 
-        // Resize if sizes mismatch
-        if (refFrame.size() != distFrame.size()) {
-            resize(distFrame, distFrame, refFrame.size());
-        }
+            double psnr = getPSNR(refAligned, distAligned, bitDepthHint, &rend.tiles);
+            Scalar ssim = getMSSIM(refAligned, distAligned, bitDepthHint, &rend.tiles);
 
-        double psnr = getPSNR(refFrame, distFrame);
-        Scalar ssim = getMSSIM(refFrame, distFrame);
+            if (rend.tiles.enabled()) {
+                accumulateTiles(rend, frameCount);
+            }
 
-        totalPSNR += psnr;
-        totalSSIM += ssim;
+            rend.totalPSNR += psnr;
+            rend.totalSSIM += ssim;
+            rend.lastPSNR = psnr;
+        }
         processedFrames++;
         
         // Progress update every 30 processed frames or every 10%
@@ -100,7 +347,7 @@ int main(int argc, char** argv) {
                  << " (" << fixed << setprecision(1) << progress << "%)"
                  << " | Processed: " << processedFrames
                  << " | " << setprecision(1) << framesPerSec << " fps"
-                 << " | Current PSNR: " << setprecision(2) << psnr << " dB"
+                 << " | Current PSNR: " << setprecision(2) << renditions[0].lastPSNR << " dB"
                  << " | ETA: " << remaining << "s      " << flush;
         }
     }
@@ -108,21 +355,29 @@ int main(int argc, char** argv) {
     cout << endl << endl;
 
     refVideo.release();
-    distVideo.release();
+    for (size_t r = 0; r < renditions.size(); ++r) {
+        renditions[r].video.release();
+    }
 
     if (processedFrames == 0) {
         cerr << "Error: No frames were processed!" << endl;
         return -1;
     }
 
-    double avgPSNR = totalPSNR / processedFrames;
-    double avgSSIM = (totalSSIM[0] + totalSSIM[1] + totalSSIM[2]) / (3 * processedFrames);
-
-    // Output results in the format expected by batch_eval.sh
-    cout << "Results:" << endl;
-    cout << "  Frames processed: " << processedFrames << " of " << totalFrames << endl;
-    cout << "  Average PSNR: " << fixed << setprecision(2) << avgPSNR << " dB" << endl;
-    cout << "  Average SSIM: " << fixed << setprecision(4) << avgSSIM << endl;
+    for (size_t r = 0; r < renditions.size(); ++r) {
+        if (r > 0) cout << endl;
+        printResults(renditions[r], processedFrames, totalFrames,
+                     renditions.size() > 1, temporal);
+    }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char** argv) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return -1;
+    }
+}
@@ -1,17 +1,60 @@
 #include <iostream>
 #include <string>
+#include <cstdlib>
 #include "dashboard.h"
+#include "ladder.h"
+
+static void printUsage(const char* prog) {
+    std::cout << "Video Quality Dashboard" << std::endl;
+    std::cout << "Usage: " << prog << " <original_video> <compressed_video> [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --tile-size <N>           SSIM tile map size, 0 for pixel difference (default 64)" << std::endl;
+    std::cout << "  --ssim-floor <S>          Tile SSIM drawn at full heat (default 0.7)" << std::endl;
+    std::cout << "  --scaler <name>           nearest, bilinear (default), bicubic, area, lanczos" << std::endl;
+    std::cout << "  --bit-depth <8|10|12|16>  Significant bits of 16-bit frames (default 16)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << prog << " data/input.mp4 data/compressed/output_500k.mp4" << std::endl;
+}
 
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cout << "Video Quality Dashboard" << std::endl;
-        std::cout << "Usage: " << argv[0] << " <original_video> <compressed_video>" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Example:" << std::endl;
-        std::cout << "  " << argv[0] << " data/input.mp4 data/compressed/output_500k.mp4" << std::endl;
+    if (argc < 3) {
+        printUsage(argv[0]);
         return -1;
     }
 
+    int tileSize = -1;
+    int bitDepthHint = 0;
+    double ssimFloor = 0.7;
+    int interpolation = cv::INTER_LINEAR;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return -1;
+        }
+        if (arg == "--tile-size") {
+            tileSize = std::atoi(argv[++i]);
+        } else if (arg == "--ssim-floor") {
+            ssimFloor = std::atof(argv[++i]);
+        } else if (arg == "--scaler") {
+            interpolation = VideoQuality::parseScaler(argv[++i]);
+            if (interpolation < 0) {
+                std::cerr << "Error: Unknown scaler " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--bit-depth") {
+            bitDepthHint = std::atoi(argv[++i]);
+            if (!isSupportedBitDepth(bitDepthHint)) {
+                std::cerr << "Error: Unsupported bit depth " << bitDepthHint << std::endl;
+                return -1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
     std::string originalPath = argv[1];
     std::string compressedPath = argv[2];
 
@@ -21,7 +64,12 @@ int main(int argc, char** argv) {
         std::cout << "Compressed: " << compressedPath << std::endl;
         std::cout << std::endl;
 
-        VideoQuality::Dashboard dashboard(originalPath, compressedPath);
+        VideoQuality::Dashboard dashboard(originalPath, compressedPath, bitDepthHint);
+        if (tileSize >= 0) {
+            dashboard.setTileSize(tileSize);
+        }
+        dashboard.setSSIMFloor(ssimFloor);
+        dashboard.setInterpolation(interpolation);
         dashboard.run();
 
         std::cout << "Dashboard closed." << std::endl;
@@ -31,4 +79,4 @@ int main(int argc, char** argv) {
         std::cerr << "Error: " << e.what() << std::endl;
         return -1;
     }
-}
\ No newline at end of file
+}
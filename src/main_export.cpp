@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "exporter.h"
+#include "ladder.h"
+
+static void printUsage(const char* prog) {
+    std::cout << "Comparison Video Export" << std::endl;
+    std::cout << "Usage: " << prog << " <original_video> <compressed_video> <output_video> [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --panel-width <N>         Width of each panel (default 640)" << std::endl;
+    std::cout << "  --alpha <A>               Heatmap overlay opacity (default 0.5)" << std::endl;
+    std::cout << "  --tile-size <N>           SSIM tile map size, 0 for pixel difference (default 64)" << std::endl;
+    std::cout << "  --ssim-floor <S>          Tile SSIM drawn at full heat (default 0.7)" << std::endl;
+    std::cout << "  --scaler <name>           nearest, bilinear (default), bicubic, area, lanczos" << std::endl;
+    std::cout << "  --bit-depth <8|10|12|16>  Significant bits of 16-bit frames (default 16)" << std::endl;
+    std::cout << "  --threads <N>             Render threads (default: cores - 2)" << std::endl;
+    std::cout << "  --fourcc <CODE>           VideoWriter codec (default mp4v, ignored for .y4m)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << prog << " data/input.mp4 data/compressed/output_500k.mp4 results/review_500k.mp4" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return -1;
+    }
+
+    VideoQuality::ComparisonExporter::Options options;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return -1;
+        }
+        if (arg == "--panel-width") {
+            options.panelWidth = std::atoi(argv[++i]);
+        } else if (arg == "--alpha") {
+            options.heatmapAlpha = std::atof(argv[++i]);
+        } else if (arg == "--tile-size") {
+            options.tileSize = std::atoi(argv[++i]);
+        } else if (arg == "--ssim-floor") {
+            options.ssimFloor = std::atof(argv[++i]);
+        } else if (arg == "--scaler") {
+            options.interpolation = VideoQuality::parseScaler(argv[++i]);
+            if (options.interpolation < 0) {
+                std::cerr << "Error: Unknown scaler " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--bit-depth") {
+            options.bitDepthHint = std::atoi(argv[++i]);
+            if (!isSupportedBitDepth(options.bitDepthHint)) {
+                std::cerr << "Error: Unsupported bit depth " << options.bitDepthHint << std::endl;
+                return -1;
+            }
+        } else if (arg == "--threads") {
+            options.renderThreads = std::atoi(argv[++i]);
+        } else if (arg == "--fourcc") {
+            options.fourcc = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    try {
+        std::cout << "Original: " << argv[1] << std::endl;
+        std::cout << "Compressed: " << argv[2] << std::endl;
+        std::cout << std::endl;
+
+        VideoQuality::ComparisonExporter exporter(argv[1], argv[2], options);
+        int frames = exporter.run(argv[3]);
+
+        std::cout << "Exported " << frames << " frames to " << argv[3] << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
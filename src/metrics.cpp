@@ -1,35 +1,112 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <cmath>
+#include <stdexcept>
+#include "metrics.h"
 
 using namespace cv;
 using namespace std;
 
-// ---------- PSNR ----------
-double getPSNR(const Mat& I1, const Mat& I2) {
-    Mat s1;
-    absdiff(I1, I2, s1);       // |I1 - I2|
-    s1.convertTo(s1, CV_32F);  // convert to float
-    s1 = s1.mul(s1);           // square
+// ---------- Format dispatch ----------
+bool isSupportedBitDepth(int bitDepth) {
+    return bitDepth == 8 || bitDepth == 10 || bitDepth == 12 || bitDepth == 16;
+}
+
+int resolveBitDepth(const Mat& frame, int bitDepthHint) {
+    switch (frame.depth()) {
+        case CV_8U:
+            return 8;
+        case CV_16U:
+            if (bitDepthHint == 8) {
+                throw runtime_error("Bit depth 8 requested for 16-bit frames");
+            }
+            if (bitDepthHint == 10 || bitDepthHint == 12) return bitDepthHint;
+            return 16;
+        default:
+            throw runtime_error("Unsupported frame depth (expected 8U or 16U)");
+    }
+}
+
+// ---------- Capture ----------
+bool openCapture(VideoCapture& capture, const string& path, int bitDepthHint) {
+    if (!capture.open(path)) return false;
+    if (bitDepthHint > 8) {
+        // Request 16-bit BGR instead of the default 8-bit conversion; backends
+        // that cannot deliver it ignore the request
+        capture.set(CAP_PROP_FORMAT, CV_16UC3);
+    }
+    return true;
+}
+
+bool keepsBitDepth(const Mat& frame, int bitDepthHint) {
+    return bitDepthHint <= 8 || frame.depth() != CV_8U;
+}
+
+bool fitsBitDepth(const Mat& frame, int bitDepthHint) {
+    int bits = resolveBitDepth(frame, bitDepthHint);
+    double maxSample;
+    minMaxLoc(frame.reshape(1), 0, &maxSample);
+    return maxSample <= double((1 << bits) - 1);
+}
 
-    Scalar s = sum(s1);        // sum all elements per channel
+// ---------- Tiles ----------
+static void prepareTileGrid(int tileSize, const Size& frameSize, Mat& grid) {
+    int tilesX = (frameSize.width + tileSize - 1) / tileSize;
+    int tilesY = (frameSize.height + tileSize - 1) / tileSize;
+    grid.create(tilesY, tilesX, CV_32F);
+}
+
+static Rect tileRect(const Size& frameSize, int tileSize, int tx, int ty) {
+    return Rect(tx * tileSize, ty * tileSize, tileSize, tileSize) &
+           Rect(0, 0, frameSize.width, frameSize.height);
+}
 
-    double sse = s.val[0] + s.val[1] + s.val[2]; // sum channels
+// ---------- PSNR ----------
+template <typename Traits>
+double getPSNR(const Mat& I1, const Mat& I2, TileMetrics* tiles) {
+    CV_Assert(I1.depth() == Traits::depth && I1.type() == I2.type());
+
+    const double peak2 = Traits::peak() * Traits::peak();
+
+    // Sum of squared differences over all channels. NORM_L2SQR runs the
+    // depth-specific SIMD loop without temporary float buffers.
+    double sse = 0;
+    if (tiles && tiles->enabled()) {
+        // Frame SSE is the sum of tile SSEs, so tiles cost no extra pass
+        prepareTileGrid(tiles->tileSize, I1.size(), tiles->psnr);
+        for (int ty = 0; ty < tiles->psnr.rows; ++ty) {
+            float* row = tiles->psnr.ptr<float>(ty);
+            for (int tx = 0; tx < tiles->psnr.cols; ++tx) {
+                Rect r = tileRect(I1.size(), tiles->tileSize, tx, ty);
+                double tileSSE = norm(I1(r), I2(r), NORM_L2SQR);
+                double tileMSE = tileSSE / (double)(I1.channels() * r.area());
+                sse += tileSSE;
+                row[tx] = (tileSSE <= 1e-10) ? (float)TILE_PSNR_MAX
+                        : (float)min(TILE_PSNR_MAX, 10.0 * log10(peak2 / tileMSE));
+            }
+        }
+    } else {
+        sse = norm(I1, I2, NORM_L2SQR);
+    }
     if (sse <= 1e-10) return 0; // no difference
 
     double mse  = sse / (double)(I1.channels() * I1.total());
-    double psnr = 10.0 * log10((255 * 255) / mse);
+    double psnr = 10.0 * log10(peak2 / mse);
     return psnr;
 }
 
 // ---------- SSIM ----------
-Scalar getMSSIM(const Mat& i1, const Mat& i2) {
-    const double C1 = 6.5025, C2 = 58.5225;
+template <typename Traits>
+Scalar getMSSIM(const Mat& i1, const Mat& i2, TileMetrics* tiles) {
+    CV_Assert(i1.depth() == Traits::depth && i1.type() == i2.type());
+
+    const double C1 = Traits::ssimC1(), C2 = Traits::ssimC2();
     int d = CV_32F;
 
+    // Every format is widened to float here; only the scale and C1/C2 differ
     Mat I1, I2;
-    i1.convertTo(I1, d);
-    i2.convertTo(I2, d);
+    i1.convertTo(I1, d, Traits::ssimScale());
+    i2.convertTo(I2, d, Traits::ssimScale());
 
     Mat I2_2 = I2.mul(I2);    // I2^2
     Mat I1_2 = I1.mul(I1);    // I1^2
@@ -66,6 +143,54 @@ Scalar getMSSIM(const Mat& i1, const Mat& i2) {
 
     Mat ssim_map;
     divide(t3, t1, ssim_map);
-    Scalar mssim = mean(ssim_map);
-    return mssim; // per-channel SSIM
+
+    if (!tiles || !tiles->enabled()) {
+        Scalar mssim = mean(ssim_map);
+        return mssim; // per-channel SSIM
+    }
+
+    // Reduce ssim_map per tile; the frame mean is accumulated from the tile sums
+    prepareTileGrid(tiles->tileSize, ssim_map.size(), tiles->ssim);
+    const int cn = ssim_map.channels();
+    Scalar total = Scalar::all(0);
+    for (int ty = 0; ty < tiles->ssim.rows; ++ty) {
+        float* row = tiles->ssim.ptr<float>(ty);
+        for (int tx = 0; tx < tiles->ssim.cols; ++tx) {
+            Rect r = tileRect(ssim_map.size(), tiles->tileSize, tx, ty);
+            Scalar s = sum(ssim_map(r));
+            double tileSum = 0;
+            for (int c = 0; c < cn; ++c) tileSum += s[c];
+            row[tx] = (float)(tileSum / (cn * r.area()));
+            total += s;
+        }
+    }
+    return total * (1.0 / ssim_map.total()); // per-channel SSIM
+}
+
+template double getPSNR<Sample8>(const Mat&, const Mat&, TileMetrics*);
+template double getPSNR<Sample10>(const Mat&, const Mat&, TileMetrics*);
+template double getPSNR<Sample12>(const Mat&, const Mat&, TileMetrics*);
+template double getPSNR<Sample16>(const Mat&, const Mat&, TileMetrics*);
+
+template Scalar getMSSIM<Sample8>(const Mat&, const Mat&, TileMetrics*);
+template Scalar getMSSIM<Sample10>(const Mat&, const Mat&, TileMetrics*);
+template Scalar getMSSIM<Sample12>(const Mat&, const Mat&, TileMetrics*);
+template Scalar getMSSIM<Sample16>(const Mat&, const Mat&, TileMetrics*);
+
+double getPSNR(const Mat& I1, const Mat& I2, int bitDepthHint, TileMetrics* tiles) {
+    switch (resolveBitDepth(I1, bitDepthHint)) {
+        case 10: return getPSNR<Sample10>(I1, I2, tiles);
+        case 12: return getPSNR<Sample12>(I1, I2, tiles);
+        case 16: return getPSNR<Sample16>(I1, I2, tiles);
+        default: return getPSNR<Sample8>(I1, I2, tiles);
+    }
+}
+
+Scalar getMSSIM(const Mat& i1, const Mat& i2, int bitDepthHint, TileMetrics* tiles) {
+    switch (resolveBitDepth(i1, bitDepthHint)) {
+        case 10: return getMSSIM<Sample10>(i1, i2, tiles);
+        case 12: return getMSSIM<Sample12>(i1, i2, tiles);
+        case 16: return getMSSIM<Sample16>(i1, i2, tiles);
+        default: return getMSSIM<Sample8>(i1, i2, tiles);
+    }
 }
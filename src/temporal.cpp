@@ -0,0 +1,136 @@
+#include "temporal.h"
+#include "metrics.h"
+#include <bitset>
+#include <cstdlib>
+
+namespace VideoQuality {
+
+// Bits by which a new lag must beat the current one before it is adopted
+static const int LAG_SWITCH_MARGIN = 2;
+
+static int hammingDistance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+void computeTemporalFrame(const cv::Mat& frame, int bitDepthHint, TemporalFrame& out) {
+    // Reduce first so the colour conversion only touches the thumbnail
+    cv::Mat small;
+    cv::resize(frame, small, TEMPORAL_THUMBNAIL_SIZE, 0, 0, cv::INTER_AREA);
+    if (small.channels() == 3) {
+        cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+    }
+    int bits = resolveBitDepth(frame, bitDepthHint);
+    small.convertTo(out.thumbnail, CV_32F, 255.0 / ((1 << bits) - 1));
+
+    // dHash: sign of horizontal gradients on a 9x8 reduction
+    cv::Mat tiny;
+    cv::resize(out.thumbnail, tiny, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const float* row = tiny.ptr<float>(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | (row[x] > row[x + 1] ? 1u : 0u);
+        }
+    }
+    out.hash = hash;
+}
+
+TemporalAnalyzer::TemporalAnalyzer(int window, int hashThreshold)
+    : window_(window), hashThreshold_(hashThreshold), frames_(0), pairs_(0),
+      lag_(0), totalReferenceEnergy_(0.0), totalDistortedEnergy_(0.0),
+      totalFlicker_(0.0), duplicated_(0), dropped_(0), misaligned_(0),
+      lastFlicker_(0.0), lastEvent_(FRAME_OK) {}
+
+void TemporalAnalyzer::update(const TemporalFrame& reference,
+                              const TemporalFrame& distorted) {
+    lastFlicker_ = 0.0;
+    lastEvent_ = FRAME_OK;
+
+    if (frames_ > 0) {
+        // Frame-difference energy of each stream, and the temporal change
+        // the encode added or removed (flicker)
+        cv::subtract(reference.thumbnail, prevReference_, referenceDelta_);
+        cv::subtract(distorted.thumbnail, prevDistorted_, distortedDelta_);
+        double pixels = static_cast<double>(referenceDelta_.total());
+        totalReferenceEnergy_ += cv::norm(referenceDelta_, cv::NORM_L2SQR) / pixels;
+        totalDistortedEnergy_ += cv::norm(distortedDelta_, cv::NORM_L2SQR) / pixels;
+        lastFlicker_ = cv::norm(referenceDelta_, distortedDelta_, cv::NORM_L1) / pixels;
+        totalFlicker_ += lastFlicker_;
+        ++pairs_;
+
+        updateAlignment(reference.hash, distorted.hash);
+    }
+
+    // Copy rather than share: callers may reuse their thumbnail buffers
+    reference.thumbnail.copyTo(prevReference_);
+    distorted.thumbnail.copyTo(prevDistorted_);
+
+    referenceHashes_.push_front(reference.hash);
+    distortedHashes_.push_front(distorted.hash);
+    if (static_cast<int>(referenceHashes_.size()) > window_) {
+        referenceHashes_.pop_back();
+        distortedHashes_.pop_back();
+    }
+    ++frames_;
+}
+
+int TemporalAnalyzer::lagCost(int lag, uint64_t referenceHash,
+                              uint64_t distortedHash) const {
+    // lag > 0 compares the distorted frame with reference t-lag, lag < 0
+    // compares the reference frame with distorted t+lag. The hash rings do
+    // not hold the current frame yet.
+    if (lag == 0) {
+        return hammingDistance(referenceHash, distortedHash);
+    }
+    if (lag > 0 && lag <= static_cast<int>(referenceHashes_.size())) {
+        return hammingDistance(distortedHash, referenceHashes_[lag - 1]);
+    }
+    if (lag < 0 && -lag <= static_cast<int>(distortedHashes_.size())) {
+        return hammingDistance(referenceHash, distortedHashes_[-lag - 1]);
+    }
+    return -1;
+}
+
+void TemporalAnalyzer::updateAlignment(uint64_t referenceHash, uint64_t distortedHash) {
+    // Only a reference that visibly moved can reveal drift; static or slowly
+    // changing lossy content keeps the current lag
+    int referenceMotion = hammingDistance(referenceHash, referenceHashes_[0]);
+    if (referenceMotion > hashThreshold_) {
+        // Duplicate: the distorted picture repeats while the reference moves on.
+        // Drop: the distorted picture moves on and lands on a newer reference.
+        int distortedMotion = hammingDistance(distortedHash, distortedHashes_[0]);
+        int candidate = distortedMotion <= hashThreshold_ ? lag_ + 1 : lag_ - 1;
+        int cost = std::abs(candidate) <= window_
+            ? lagCost(candidate, referenceHash, distortedHash) : -1;
+        int current = lagCost(lag_, referenceHash, distortedHash);
+
+        // The new lag must be a confident match and clearly beat the current one
+        if (cost >= 0 && cost <= hashThreshold_ &&
+            (current < 0 || cost + LAG_SWITCH_MARGIN <= current)) {
+            if (candidate > lag_) {
+                ++duplicated_;
+                lastEvent_ = FRAME_DUPLICATED;
+            } else {
+                ++dropped_;
+                lastEvent_ = FRAME_DROPPED;
+            }
+            lag_ = candidate;
+        }
+    }
+
+    if (lag_ != 0) ++misaligned_;
+}
+
+double TemporalAnalyzer::meanReferenceEnergy() const {
+    return pairs_ > 0 ? totalReferenceEnergy_ / pairs_ : 0.0;
+}
+
+double TemporalAnalyzer::meanDistortedEnergy() const {
+    return pairs_ > 0 ? totalDistortedEnergy_ / pairs_ : 0.0;
+}
+
+double TemporalAnalyzer::meanFlicker() const {
+    return pairs_ > 0 ? totalFlicker_ / pairs_ : 0.0;
+}
+
+} // namespace VideoQuality